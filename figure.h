@@ -17,6 +17,8 @@ public:
     
     virtual void printVertices(std::ostream& os) const = 0;
     
+    virtual const std::vector<std::pair<double, double>>& getVertices() const = 0;
+    
     virtual void readFromStream(std::istream& is) = 0;
     
     virtual operator double() const = 0;
@@ -0,0 +1,522 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include "figure.h"
+#include "trapezoid.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include "array.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+
+// Ограниченная очередь между стадиями конвейера.
+// push блокируется, пока очередь заполнена (обратное давление),
+// pop блокируется, пока очередь пуста и не закрыта.
+template <typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+
+public:
+    explicit BoundedQueue(size_t cap) : capacity(cap == 0 ? 1 : cap) {}
+
+    void push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return items.size() < capacity || closed; });
+        if (closed) {
+            throw std::logic_error("Запись в закрытую очередь");
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    // Возвращает false, когда очередь закрыта и опустошена
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return !items.empty() || closed; });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+};
+
+// Параметры конвейера: число потоков на каждой стадии и ёмкость очередей.
+// Стадия добавления всегда одна, так как FigureArray не потокобезопасен.
+// Файлы читаются блоками примерно по blockSize байт, выровненными по строкам,
+// и дальше по конвейеру передаются пакетами по одному блоку, поэтому
+// в каждой очереди одновременно находится не больше queueCapacity блоков,
+// а один большой файл разбирается несколькими потоками.
+// Строка длиннее blockSize целиком попадает в один блок.
+// reorderBlocks - сколько блоков последующих файлов может ожидать
+// в буфере упорядочивания, пока не добавлен предыдущий файл.
+struct IngestConfig {
+    size_t readers = 2;
+    size_t parsers = 2;
+    size_t validators = 2;
+    size_t queueCapacity = 64;
+    size_t blockSize = 64 * 1024;
+    size_t reorderBlocks = 64;
+};
+
+// Статистика одной стадии: обработанные элементы, число потоков и
+// суммарное время работы потоков без ожидания на очередях.
+// throughput - сколько элементов в секунду стадия успевает обработать
+// при полной загрузке всех своих потоков; самая медленная стадия
+// и ограничивает скорость конвейера.
+struct StageStats {
+    size_t items = 0;
+    size_t workers = 0;
+    double seconds = 0.0;
+
+    double throughput() const {
+        return seconds > 0.0 ? items * workers / seconds : 0.0;
+    }
+};
+
+// read.items - число прочитанных блоков, parse.items - разобранных строк,
+// validate.items - корректных фигур, append.items - добавленных фигур
+struct IngestStats {
+    StageStats read;
+    StageStats parse;
+    StageStats validate;
+    StageStats append;
+    size_t bytesRead = 0;
+    size_t rejected = 0;
+    std::vector<std::string> failedFiles;
+
+    // Скорость чтения в байтах в секунду, не зависящая от blockSize
+    double readBytesPerSecond() const {
+        return read.seconds > 0.0 ? bytesRead * read.workers / read.seconds : 0.0;
+    }
+};
+
+// Асинхронная загрузка фигур из набора файлов.
+// Формат файла: одна фигура на строку, первым идёт тип
+// (1 - трапеция, 2 - ромб, 3 - пятиугольник), далее координаты вершин.
+// Пустые строки и строки, начинающиеся с '#', пропускаются.
+// Некорректные строки и фигуры не прерывают загрузку и учитываются в rejected,
+// файлы, которые не удалось открыть или дочитать, перечисляются в failedFiles
+// (фигуры из прочитанной части файла добавляются).
+// Фигуры добавляются в порядке файлов во входном списке и строк в файле.
+class FigureIngest {
+private:
+    struct FigureRecord {
+        int type = 0;
+        std::vector<std::pair<double, double>> vertices;
+    };
+
+    // Положение блока во входных данных; last - последний блок файла
+    struct BlockKey {
+        size_t file = 0;
+        size_t seq = 0;
+        bool last = false;
+    };
+
+    struct TextBlock {
+        BlockKey key;
+        std::string text;
+    };
+
+    struct RecordBatch {
+        BlockKey key;
+        std::vector<FigureRecord> records;
+    };
+
+    struct FigureBatch {
+        BlockKey key;
+        std::vector<std::unique_ptr<Figure>> figures;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Ограничивает число блоков, ожидающих упорядочивания. Блоки файла,
+    // который сейчас добавляется, пропускаются всегда, иначе конвейер
+    // мог бы заполниться блоками последующих файлов и остановиться.
+    class ReorderWindow {
+    private:
+        std::mutex mutex;
+        std::condition_variable released;
+        size_t limit;
+        size_t inFlight = 0;
+        size_t currentFile = 0;
+        bool aborted = false;
+
+    public:
+        explicit ReorderWindow(size_t l) : limit(l == 0 ? 1 : l) {}
+
+        void admit(size_t file) {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [this, file] {
+                return aborted || file == currentFile || inFlight < limit;
+            });
+            if (aborted) {
+                throw std::logic_error("Конвейер остановлен");
+            }
+            ++inFlight;
+        }
+
+        void release(size_t nextFile) {
+            std::lock_guard<std::mutex> lock(mutex);
+            --inFlight;
+            currentFile = nextFile;
+            released.notify_all();
+        }
+
+        void abort() {
+            std::lock_guard<std::mutex> lock(mutex);
+            aborted = true;
+            released.notify_all();
+        }
+    };
+
+    // Останавливает конвейер и дожидается всех потоков при выходе из run,
+    // в том числе при исключении
+    class ThreadGuard {
+    private:
+        std::vector<std::thread>& threads;
+        std::function<void()> abort;
+
+    public:
+        ThreadGuard(std::vector<std::thread>& t, std::function<void()> a)
+            : threads(t), abort(std::move(a)) {}
+        ThreadGuard(const ThreadGuard&) = delete;
+        ThreadGuard& operator=(const ThreadGuard&) = delete;
+
+        void join() {
+            for (auto& t : threads) {
+                if (t.joinable()) t.join();
+            }
+        }
+
+        ~ThreadGuard() {
+            abort();
+            join();
+        }
+    };
+
+    IngestConfig config;
+
+    static size_t vertexCount(int type) {
+        switch (type) {
+            case 1: return 4;
+            case 2: return 4;
+            case 3: return 5;
+            default: return 0;
+        }
+    }
+
+    static std::unique_ptr<Figure> makeFigure(const FigureRecord& record) {
+        switch (record.type) {
+            case 1: return std::make_unique<Trapezoid>(record.vertices);
+            case 2: return std::make_unique<Rhombus>(record.vertices);
+            case 3: return std::make_unique<Pentagon>(record.vertices);
+            default: return nullptr;
+        }
+    }
+
+    static bool parseLine(const std::string& line, FigureRecord& record, bool& skip) {
+        std::istringstream is(line);
+        std::string first;
+        skip = false;
+        if (!(is >> first) || first[0] == '#') {
+            skip = true;
+            return false;
+        }
+
+        std::istringstream typeStream(first);
+        if (!(typeStream >> record.type) || !typeStream.eof()) return false;
+        size_t count = vertexCount(record.type);
+        if (count == 0) return false;
+
+        record.vertices.clear();
+        for (size_t i = 0; i < count; ++i) {
+            double x, y;
+            if (!(is >> x >> y)) return false;
+            record.vertices.emplace_back(x, y);
+        }
+
+        std::string rest;
+        return !(is >> rest);
+    }
+
+    // Читает очередной блок: blockSize байт, дополненные до конца строки.
+    // Возвращает false в конце файла или при ошибке чтения.
+    static bool readBlock(std::istream& file, size_t blockSize, std::string& text) {
+        text.assign(blockSize == 0 ? 1 : blockSize, '\0');
+        file.read(&text[0], text.size());
+        text.resize(static_cast<size_t>(file.gcount()));
+        if (text.empty()) return false;
+
+        if (file && text.back() != '\n') {
+            std::string tail;
+            std::getline(file, tail);
+            text += tail;
+            if (!file.eof()) text += '\n';
+        }
+        return true;
+    }
+
+    static double elapsed(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    // Запись в очередь, не учитываемая во времени работы потока
+    template <typename T>
+    static void pushPaused(BoundedQueue<T>& queue, T item, double& busy, Clock::time_point& mark) {
+        busy += elapsed(mark);
+        queue.push(std::move(item));
+        mark = Clock::now();
+    }
+
+    // Запускает workers потоков body(busy); по завершении последнего закрывает next.
+    // Исключения потоков передаются в onError.
+    template <typename Body, typename Next, typename OnError>
+    static void startStage(std::vector<std::thread>& threads, size_t workers,
+                           Body body, Next& next, std::atomic<size_t>& remaining,
+                           std::vector<double>& busy, OnError onError) {
+        if (workers == 0) workers = 1;
+        busy.assign(workers, 0.0);
+        remaining = workers;
+        for (size_t i = 0; i < workers; ++i) {
+            threads.emplace_back([body, onError, i, &next, &remaining, &busy] {
+                try {
+                    body(busy[i]);
+                } catch (...) {
+                    onError(std::current_exception());
+                }
+                if (--remaining == 0) {
+                    next.close();
+                }
+            });
+        }
+    }
+
+    static void finishStage(StageStats& stats, size_t items, const std::vector<double>& busy) {
+        stats.items = items;
+        stats.workers = busy.size();
+        stats.seconds = 0.0;
+        for (double b : busy) {
+            stats.seconds += b;
+        }
+    }
+
+public:
+    FigureIngest() = default;
+    explicit FigureIngest(const IngestConfig& cfg) : config(cfg) {}
+
+    const IngestConfig& getConfig() const { return config; }
+
+    // Загружает фигуры из файлов и добавляет их в target.
+    // Непредвиденная ошибка в любой стадии (например, нехватка памяти)
+    // останавливает конвейер и выбрасывается после завершения всех потоков;
+    // добавленные к этому моменту фигуры остаются в target.
+    IngestStats run(const std::vector<std::string>& paths, FigureArray& target) {
+        return run(paths, [&target](std::unique_ptr<Figure> figure) {
+            target.addFigure(std::move(figure));
+        });
+    }
+
+    // То же, но каждая фигура передаётся в append (вызывается в текущем потоке)
+    IngestStats run(const std::vector<std::string>& paths,
+                    const std::function<void(std::unique_ptr<Figure>)>& append) {
+        IngestStats stats;
+
+        BoundedQueue<std::pair<size_t, std::string>> pathQueue(config.queueCapacity);
+        BoundedQueue<TextBlock> blockQueue(config.queueCapacity);
+        BoundedQueue<RecordBatch> recordQueue(config.queueCapacity);
+        BoundedQueue<FigureBatch> figureQueue(config.queueCapacity);
+        ReorderWindow window(config.reorderBlocks);
+
+        std::atomic<size_t> readCount{0}, bytesRead{0};
+        std::atomic<size_t> parseCount{0}, validateCount{0}, rejected{0};
+        std::atomic<size_t> readersLeft{0}, parsersLeft{0}, validatorsLeft{0};
+        std::vector<double> readBusy, parseBusy, validateBusy;
+
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        std::vector<std::pair<size_t, std::string>> failedFiles;
+
+        auto abort = [&] {
+            window.abort();
+            pathQueue.close();
+            blockQueue.close();
+            recordQueue.close();
+            figureQueue.close();
+        };
+        auto fail = [&](std::exception_ptr e) {
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = e;
+            }
+            abort();
+        };
+
+        std::vector<std::thread> threads;
+        ThreadGuard guard(threads, abort);
+
+        startStage(threads, config.readers, [&](double& busy) {
+            std::pair<size_t, std::string> path;
+            while (pathQueue.pop(path)) {
+                Clock::time_point mark = Clock::now();
+                size_t index = path.first;
+                size_t seq = 0;
+
+                std::ifstream file(path.second, std::ios::binary);
+                bool opened = static_cast<bool>(file);
+                std::string text;
+                while (opened && readBlock(file, config.blockSize, text)) {
+                    bytesRead += text.size();
+                    ++readCount;
+                    busy += elapsed(mark);
+                    window.admit(index);
+                    blockQueue.push(TextBlock{BlockKey{index, seq++, false}, std::move(text)});
+                    mark = Clock::now();
+                }
+
+                if (!opened || file.bad() || !file.eof()) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    failedFiles.emplace_back(index, path.second);
+                }
+
+                // Пустой завершающий блок отмечает конец файла, даже если он не прочитан
+                busy += elapsed(mark);
+                window.admit(index);
+                blockQueue.push(TextBlock{BlockKey{index, seq, true}, std::string()});
+            }
+        }, blockQueue, readersLeft, readBusy, fail);
+
+        startStage(threads, config.parsers, [&](double& busy) {
+            TextBlock block;
+            while (blockQueue.pop(block)) {
+                Clock::time_point mark = Clock::now();
+                RecordBatch batch{block.key, {}};
+                std::istringstream is(block.text);
+                std::string line;
+                while (std::getline(is, line)) {
+                    FigureRecord record;
+                    bool skip;
+                    if (parseLine(line, record, skip)) {
+                        batch.records.push_back(std::move(record));
+                    } else if (!skip) {
+                        ++rejected;
+                    }
+                }
+                parseCount += batch.records.size();
+                pushPaused(recordQueue, std::move(batch), busy, mark);
+            }
+        }, recordQueue, parsersLeft, parseBusy, fail);
+
+        startStage(threads, config.validators, [&](double& busy) {
+            RecordBatch records;
+            while (recordQueue.pop(records)) {
+                Clock::time_point mark = Clock::now();
+                FigureBatch batch{records.key, {}};
+                for (const auto& record : records.records) {
+                    try {
+                        batch.figures.push_back(makeFigure(record));
+                    } catch (const std::invalid_argument&) {
+                        ++rejected;
+                    }
+                }
+                validateCount += batch.figures.size();
+                pushPaused(figureQueue, std::move(batch), busy, mark);
+            }
+        }, figureQueue, validatorsLeft, validateBusy, fail);
+
+        // Пути подаются отдельным потоком, чтобы стадия добавления
+        // работала в вызывающем потоке без взаимной блокировки
+        threads.emplace_back([&] {
+            try {
+                for (size_t i = 0; i < paths.size(); ++i) {
+                    pathQueue.push({i, paths[i]});
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            pathQueue.close();
+        });
+
+        // Пакеты, пришедшие раньше предыдущих, ждут в pending
+        size_t appended = 0;
+        std::vector<double> appendBusy(1, 0.0);
+        try {
+            std::map<std::pair<size_t, size_t>, FigureBatch> pending;
+            size_t nextFile = 0, nextSeq = 0;
+            FigureBatch batch;
+            while (figureQueue.pop(batch)) {
+                Clock::time_point mark = Clock::now();
+                pending.emplace(std::make_pair(batch.key.file, batch.key.seq), std::move(batch));
+
+                while (!pending.empty() &&
+                       pending.begin()->first == std::make_pair(nextFile, nextSeq)) {
+                    FigureBatch ready = std::move(pending.begin()->second);
+                    pending.erase(pending.begin());
+                    for (auto& figure : ready.figures) {
+                        append(std::move(figure));
+                        ++appended;
+                    }
+                    if (ready.key.last) {
+                        ++nextFile;
+                        nextSeq = 0;
+                    } else {
+                        ++nextSeq;
+                    }
+                    window.release(nextFile);
+                }
+                appendBusy[0] += elapsed(mark);
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+
+        guard.join();
+
+        finishStage(stats.read, readCount, readBusy);
+        finishStage(stats.parse, parseCount, parseBusy);
+        finishStage(stats.validate, validateCount, validateBusy);
+        finishStage(stats.append, appended, appendBusy);
+        stats.bytesRead = bytesRead;
+        stats.rejected = rejected;
+        std::sort(failedFiles.begin(), failedFiles.end());
+        for (auto& failed : failedFiles) {
+            stats.failedFiles.push_back(std::move(failed.second));
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return stats;
+    }
+};
+
+#endif
@@ -3,9 +3,14 @@
 #include "rhombus.h"
 #include "pentagon.h"
 #include "array.h"
+#include "ingest.h"
+#include "raster.h"
 #include <iostream>
 #include <memory>
 #include <limits>
+#include <fstream>
+#include <sstream>
+#include <string>
 
 // Функция для создания фигуры по выбору пользователя
 std::unique_ptr<Figure> createFigure(int choice) {
@@ -71,6 +76,8 @@ int main() {
         std::cout << "3. Вывести информацию о всех фигурах\n";
         std::cout << "4. Вывести общую площадь\n";
         std::cout << "5. Выход\n";
+        std::cout << "6. Загрузить фигуры из файлов\n";
+        std::cout << "7. Экспортировать сетку покрытия\n";
         std::cout << "Выберите действие: ";
         
         int choice;
@@ -148,6 +155,104 @@ int main() {
                     return 0;
                 }
                 
+                case 6: {
+                    // Пути можно указать в той же строке, что и пункт меню
+                    std::string line;
+                    std::getline(std::cin, line);
+                    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                        std::cout << "Введите пути к файлам через пробел: ";
+                        std::getline(std::cin, line);
+                    }
+                    
+                    std::vector<std::string> paths;
+                    std::istringstream pathStream(line);
+                    std::string path;
+                    while (pathStream >> path) {
+                        paths.push_back(path);
+                    }
+                    
+                    if (paths.empty()) {
+                        std::cout << "Не указано ни одного файла.\n";
+                        break;
+                    }
+                    
+                    // Строка уже считана целиком, поэтому ошибку обрабатываем здесь,
+                    // не очищая поток ввода
+                    size_t before = figures.size();
+                    FigureIngest ingest;
+                    IngestStats stats;
+                    try {
+                        stats = ingest.run(paths, figures);
+                    } catch (const std::exception& e) {
+                        std::cout << "Ошибка: " << e.what() << "\n";
+                        std::cout << "Загрузка прервана, добавлено фигур: "
+                                  << figures.size() - before << "\n";
+                        break;
+                    }
+                    
+                    std::cout << "Загружено фигур: " << stats.append.items
+                              << ", отклонено: " << stats.rejected << "\n";
+                    for (const auto& failed : stats.failedFiles) {
+                        std::cout << "  Не удалось прочитать файл: " << failed << "\n";
+                    }
+                    std::cout << "Пропускная способность стадий:\n";
+                    std::cout << "  Чтение: " << stats.readBytesPerSecond() << " байт/с\n";
+                    std::cout << "  Разбор: " << stats.parse.throughput() << " записей/с\n";
+                    std::cout << "  Проверка: " << stats.validate.throughput() << " фигур/с\n";
+                    std::cout << "  Добавление: " << stats.append.throughput() << " фигур/с\n";
+                    break;
+                }
+                
+                case 7: {
+                    if (figures.size() == 0) {
+                        std::cout << "Нет фигур для растеризации.\n";
+                        break;
+                    }
+                    
+                    RasterConfig config;
+                    std::cout << "Введите ширину и высоту сетки: ";
+                    if (!(std::cin >> config.width >> config.height)) {
+                        throw std::runtime_error("Ошибка ввода размера сетки");
+                    }
+                    
+                    size_t level;
+                    std::cout << "Введите уровень детализации (0 - полное разрешение): ";
+                    if (!(std::cin >> level)) {
+                        throw std::runtime_error("Ошибка ввода уровня");
+                    }
+                    
+                    std::string path;
+                    std::cout << "Введите путь к файлу: ";
+                    if (!(std::cin >> path)) {
+                        throw std::runtime_error("Ошибка ввода пути");
+                    }
+                    
+                    size_t depth = CoveragePyramid::depthFor(config.width, config.height);
+                    if (level >= depth) {
+                        std::cout << "Некорректный уровень! Доступно уровней: " << depth << "\n";
+                        break;
+                    }
+                    
+                    config.levels = level + 1;
+                    FigureRasterizer rasterizer(FigureRasterizer::fitToFigures(figures, config));
+                    CoveragePyramid pyramid = rasterizer.rasterizePyramid(figures);
+                    
+                    std::ofstream file(path);
+                    if (!file) {
+                        throw std::runtime_error("Не удалось открыть файл: " + path);
+                    }
+                    rasterizer.writeLevel(file, pyramid, level);
+                    file.close();
+                    if (!file) {
+                        throw std::runtime_error("Ошибка записи в файл: " + path);
+                    }
+                    
+                    const CoverageGrid& grid = pyramid.getLevel(level);
+                    std::cout << "Сетка " << grid.getWidth() << "x" << grid.getHeight()
+                              << " записана в " << path << "\n";
+                    break;
+                }
+                
                 default: {
                     std::cout << "Некорректный выбор!\n";
                     break;
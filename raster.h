@@ -0,0 +1,442 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include "figure.h"
+#include "array.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <limits>
+#include <string>
+
+// Сетка покрытия: в каждой ячейке суммарная доля её площади,
+// занятая фигурами (при перекрытии фигур значение может быть больше 1).
+// Строка 0 соответствует минимальной координате y.
+class CoverageGrid {
+private:
+    size_t width = 0;
+    size_t height = 0;
+    std::vector<double> cells;
+
+public:
+    CoverageGrid() = default;
+    CoverageGrid(size_t w, size_t h) : width(w), height(h) {
+        if (h != 0 && w > std::numeric_limits<size_t>::max() / h) {
+            throw std::invalid_argument("Слишком большой размер сетки");
+        }
+        cells.assign(w * h, 0.0);
+    }
+
+    size_t getWidth() const { return width; }
+    size_t getHeight() const { return height; }
+
+    double at(size_t x, size_t y) const {
+        if (x >= width || y >= height) {
+            throw std::out_of_range("Ячейка вне сетки");
+        }
+        return cells[y * width + x];
+    }
+
+    double& at(size_t x, size_t y) {
+        if (x >= width || y >= height) {
+            throw std::out_of_range("Ячейка вне сетки");
+        }
+        return cells[y * width + x];
+    }
+
+    // Сумма покрытия, в единицах площади ячейки
+    double total() const {
+        double sum = 0.0;
+        for (double c : cells) {
+            sum += c;
+        }
+        return sum;
+    }
+
+    // Уровень в два раза грубее: каждая ячейка - среднее блока 2x2.
+    // Ячейки за границей нечётной сетки считаются пустыми.
+    CoverageGrid downsample() const {
+        CoverageGrid coarse(width / 2 + width % 2, height / 2 + height % 2);
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                coarse.cells[(y / 2) * coarse.width + x / 2] += cells[y * width + x] * 0.25;
+            }
+        }
+        return coarse;
+    }
+};
+
+// Параметры растеризации: область плоскости, размер сетки,
+// размер тайла в ячейках, число потоков и число уровней пирамиды
+struct RasterConfig {
+    double minX = 0.0;
+    double minY = 0.0;
+    double maxX = 1.0;
+    double maxY = 1.0;
+    size_t width = 256;
+    size_t height = 256;
+    size_t tileSize = 64;
+    size_t threads = 0;  // 0 - по числу ядер
+    size_t levels = 0;   // 0 - до сетки 1x1
+};
+
+// Пирамида детализации: уровень 0 - полное разрешение,
+// каждый следующий уровень в два раза грубее предыдущего
+class CoveragePyramid {
+private:
+    std::vector<CoverageGrid> levels;
+
+public:
+    CoveragePyramid() = default;
+    CoveragePyramid(CoverageGrid base, size_t maxLevels) {
+        levels.push_back(std::move(base));
+        while ((maxLevels == 0 || levels.size() < maxLevels) &&
+               (levels.back().getWidth() > 1 || levels.back().getHeight() > 1)) {
+            levels.push_back(levels.back().downsample());
+        }
+    }
+
+    size_t size() const { return levels.size(); }
+
+    // Число уровней полной пирамиды для сетки width x height
+    static size_t depthFor(size_t width, size_t height) {
+        size_t depth = 1;
+        while (width > 1 || height > 1) {
+            width = width / 2 + width % 2;
+            height = height / 2 + height % 2;
+            ++depth;
+        }
+        return depth;
+    }
+
+    const CoverageGrid& getLevel(size_t index) const {
+        if (index < levels.size()) {
+            return levels[index];
+        }
+        throw std::out_of_range("Уровень вне диапазона");
+    }
+};
+
+// Построчная растеризация фигур со сглаживанием: покрытие ячейки равно
+// точной площади пересечения фигуры с ячейкой. Сетка делится на тайлы,
+// которые обрабатываются параллельно; каждый тайл пишет только в свои ячейки.
+// Поддерживаются только выпуклые фигуры: для самопересекающегося порядка
+// вершин, который допускает проверка трапеции, rasterize выбрасывает
+// std::invalid_argument с номером фигуры.
+class FigureRasterizer {
+private:
+    using Point = std::pair<double, double>;
+    using Polygon = std::vector<Point>;
+
+    struct Shape {
+        Polygon vertices;  // в координатах сетки, ячейка - единичный квадрат
+        double minX, minY, maxX, maxY;
+    };
+
+    RasterConfig config;
+
+    // Отсечение полуплоскостью по оси (axis 0 - x, 1 - y):
+    // keepLess - оставить часть с координатой <= value, иначе >= value
+    static Polygon clip(const Polygon& poly, int axis, double value, bool keepLess) {
+        Polygon result;
+        size_t n = poly.size();
+        for (size_t i = 0; i < n; ++i) {
+            const Point& a = poly[i];
+            const Point& b = poly[(i + 1) % n];
+            double ca = axis == 0 ? a.first : a.second;
+            double cb = axis == 0 ? b.first : b.second;
+            bool inA = keepLess ? ca <= value : ca >= value;
+            bool inB = keepLess ? cb <= value : cb >= value;
+
+            if (inA) {
+                result.push_back(a);
+            }
+            if (inA != inB) {
+                double t = (value - ca) / (cb - ca);
+                if (axis == 0) {
+                    result.emplace_back(value, a.second + t * (b.second - a.second));
+                } else {
+                    result.emplace_back(a.first + t * (b.first - a.first), value);
+                }
+            }
+        }
+        return result;
+    }
+
+    static double area(const Polygon& poly) {
+        if (poly.size() < 3) return 0.0;
+
+        double sum = 0.0;
+        size_t n = poly.size();
+        for (size_t i = 0; i < n; ++i) {
+            size_t j = (i + 1) % n;
+            sum += poly[i].first * poly[j].second - poly[j].first * poly[i].second;
+        }
+        return std::abs(sum) / 2.0;
+    }
+
+    // Выпуклость: все повороты вдоль контура в одну сторону и контур
+    // обходит фигуру ровно один раз (исключает звёзды и самопересечения)
+    static bool isConvex(const Polygon& poly) {
+        const double pi = std::acos(-1.0);
+        size_t n = poly.size();
+        int sign = 0;
+        double turn = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const Point& a = poly[i];
+            const Point& b = poly[(i + 1) % n];
+            const Point& c = poly[(i + 2) % n];
+            double dx1 = b.first - a.first, dy1 = b.second - a.second;
+            double dx2 = c.first - b.first, dy2 = c.second - b.second;
+            double cross = dx1 * dy2 - dy1 * dx2;
+            double dot = dx1 * dx2 + dy1 * dy2;
+
+            double scale = std::hypot(dx1, dy1) * std::hypot(dx2, dy2);
+            if (std::abs(cross) > 1e-12 * scale) {
+                int s = cross > 0 ? 1 : -1;
+                if (sign != 0 && s != sign) return false;
+                sign = s;
+            }
+            turn += std::atan2(cross, dot);
+        }
+        return std::abs(std::abs(turn) - 2 * pi) < 1e-6;
+    }
+
+    Shape toGrid(const Figure& figure) const {
+        double scaleX = config.width / (config.maxX - config.minX);
+        double scaleY = config.height / (config.maxY - config.minY);
+
+        Shape shape;
+        for (const auto& v : figure.getVertices()) {
+            shape.vertices.emplace_back((v.first - config.minX) * scaleX,
+                                        (v.second - config.minY) * scaleY);
+        }
+        shape.minX = shape.maxX = shape.vertices[0].first;
+        shape.minY = shape.maxY = shape.vertices[0].second;
+        for (const auto& v : shape.vertices) {
+            shape.minX = std::min(shape.minX, v.first);
+            shape.maxX = std::max(shape.maxX, v.first);
+            shape.minY = std::min(shape.minY, v.second);
+            shape.maxY = std::max(shape.maxY, v.second);
+        }
+        return shape;
+    }
+
+    // Растеризация одной фигуры в пределах тайла [x0, x1) x [y0, y1).
+    // Фигура сначала отсекается прямоугольником тайла, чтобы площади ниже
+    // не зависели от размера фигуры за пределами тайла. Затем для каждой
+    // строки фигура отсекается полосой, и покрытие ячеек получается как
+    // разность площадей частей полосы левее границ ячеек.
+    static void rasterizeShape(const Shape& shape, CoverageGrid& grid,
+                               size_t x0, size_t y0, size_t x1, size_t y1) {
+        Polygon poly = clip(shape.vertices, 0, static_cast<double>(x0), false);
+        poly = clip(poly, 0, static_cast<double>(x1), true);
+        poly = clip(poly, 1, static_cast<double>(y0), false);
+        poly = clip(poly, 1, static_cast<double>(y1), true);
+        if (poly.size() < 3) return;
+
+        double minY = poly[0].second, maxY = poly[0].second;
+        for (const auto& v : poly) {
+            minY = std::min(minY, v.second);
+            maxY = std::max(maxY, v.second);
+        }
+
+        size_t rowBegin = std::max(static_cast<size_t>(minY), y0);
+        size_t rowEnd = std::min(static_cast<size_t>(std::ceil(maxY)), y1);
+
+        for (size_t row = rowBegin; row < rowEnd; ++row) {
+            Polygon strip = clip(clip(poly, 1, static_cast<double>(row), false),
+                                 1, static_cast<double>(row + 1), true);
+            if (strip.size() < 3) continue;
+
+            double stripMinX = strip[0].first, stripMaxX = strip[0].first;
+            for (const auto& v : strip) {
+                stripMinX = std::min(stripMinX, v.first);
+                stripMaxX = std::max(stripMaxX, v.first);
+            }
+
+            size_t colBegin = std::max(static_cast<size_t>(stripMinX), x0);
+            size_t colEnd = std::min(static_cast<size_t>(std::ceil(stripMaxX)), x1);
+
+            double prev = 0.0;
+            for (size_t col = colBegin; col < colEnd; ++col) {
+                double next = area(clip(strip, 0, static_cast<double>(col + 1), true));
+                grid.at(col, row) += next - prev;
+                prev = next;
+            }
+        }
+    }
+
+public:
+    FigureRasterizer() = default;
+    explicit FigureRasterizer(const RasterConfig& cfg) : config(cfg) {}
+
+    const RasterConfig& getConfig() const { return config; }
+
+    CoverageGrid rasterize(const FigureArray& figures) const {
+        if (config.width == 0 || config.height == 0) {
+            throw std::invalid_argument("Размер сетки должен быть положительным");
+        }
+        if (!(config.maxX > config.minX) || !(config.maxY > config.minY)) {
+            throw std::invalid_argument("Некорректная область растеризации");
+        }
+
+        // Проверка до выделения памяти: произведение размеров не должно переполняться
+        if (config.width > std::numeric_limits<size_t>::max() / config.height) {
+            throw std::invalid_argument("Слишком большой размер сетки");
+        }
+
+        size_t tileSize = config.tileSize == 0 ? 64 : config.tileSize;
+        size_t tilesX = config.width / tileSize + (config.width % tileSize != 0);
+        size_t tilesY = config.height / tileSize + (config.height % tileSize != 0);
+
+        // Распределение фигур по тайлам по ограничивающим прямоугольникам
+        std::vector<Shape> shapes;
+        std::vector<std::vector<size_t>> bins(tilesX * tilesY);
+        for (size_t i = 0; i < figures.size(); ++i) {
+            const Figure* figure = figures.getFigure(i);
+            if (figure->getVertices().size() < 3) continue;
+
+            Shape shape = toGrid(*figure);
+            if (!std::isfinite(shape.minX) || !std::isfinite(shape.maxX) ||
+                !std::isfinite(shape.minY) || !std::isfinite(shape.maxY)) {
+                continue;
+            }
+            // Покрытие считается разностью площадей, что верно только для выпуклых фигур
+            if (!isConvex(shape.vertices)) {
+                throw std::invalid_argument("Фигура " + std::to_string(i + 1) +
+                                            " не является выпуклым многоугольником");
+            }
+            if (shape.maxX <= 0.0 || shape.maxY <= 0.0 ||
+                shape.minX >= config.width || shape.minY >= config.height) {
+                continue;
+            }
+
+            // Ограничение в double до приведения: координаты могут не помещаться в size_t
+            double lastX = static_cast<double>(config.width - 1);
+            double lastY = static_cast<double>(config.height - 1);
+            size_t tx0 = static_cast<size_t>(std::max(shape.minX, 0.0)) / tileSize;
+            size_t ty0 = static_cast<size_t>(std::max(shape.minY, 0.0)) / tileSize;
+            size_t tx1 = static_cast<size_t>(std::min(shape.maxX, lastX)) / tileSize;
+            size_t ty1 = static_cast<size_t>(std::min(shape.maxY, lastY)) / tileSize;
+            for (size_t ty = ty0; ty <= ty1; ++ty) {
+                for (size_t tx = tx0; tx <= tx1; ++tx) {
+                    bins[ty * tilesX + tx].push_back(shapes.size());
+                }
+            }
+            shapes.push_back(std::move(shape));
+        }
+
+        CoverageGrid grid(config.width, config.height);
+        std::atomic<size_t> nextTile{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto worker = [&] {
+            try {
+                for (size_t tile = nextTile++; tile < bins.size(); tile = nextTile++) {
+                    size_t x0 = (tile % tilesX) * tileSize;
+                    size_t y0 = (tile / tilesX) * tileSize;
+                    size_t x1 = x0 + std::min(tileSize, config.width - x0);
+                    size_t y1 = y0 + std::min(tileSize, config.height - y0);
+                    for (size_t index : bins[tile]) {
+                        rasterizeShape(shapes[index], grid, x0, y0, x1, y1);
+                    }
+                }
+            } catch (...) {
+                // Остальные потоки прекращают брать новые тайлы
+                nextTile = bins.size();
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+        };
+
+        size_t threadCount = config.threads;
+        if (threadCount == 0) {
+            threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        threadCount = std::min(threadCount, bins.size());
+
+        // Если поток не удалось создать, оставшиеся тайлы обработает текущий поток
+        std::vector<std::thread> threads;
+        try {
+            for (size_t i = 1; i < threadCount; ++i) {
+                threads.emplace_back(worker);
+            }
+        } catch (const std::system_error&) {
+        }
+        worker();
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return grid;
+    }
+
+    CoveragePyramid rasterizePyramid(const FigureArray& figures) const {
+        return CoveragePyramid(rasterize(figures), config.levels);
+    }
+
+    // Область растеризации по ограничивающему прямоугольнику всех фигур;
+    // вырожденная по одной из осей область расширяется на 1 в обе стороны
+    static RasterConfig fitToFigures(const FigureArray& figures, RasterConfig cfg) {
+        bool first = true;
+        for (size_t i = 0; i < figures.size(); ++i) {
+            for (const auto& v : figures.getFigure(i)->getVertices()) {
+                if (first) {
+                    cfg.minX = cfg.maxX = v.first;
+                    cfg.minY = cfg.maxY = v.second;
+                    first = false;
+                }
+                cfg.minX = std::min(cfg.minX, v.first);
+                cfg.maxX = std::max(cfg.maxX, v.first);
+                cfg.minY = std::min(cfg.minY, v.second);
+                cfg.maxY = std::max(cfg.maxY, v.second);
+            }
+        }
+        if (first) {
+            throw std::invalid_argument("Нет фигур для растеризации");
+        }
+        if (!(cfg.maxX > cfg.minX)) {
+            cfg.minX -= 1.0;
+            cfg.maxX += 1.0;
+        }
+        if (!(cfg.maxY > cfg.minY)) {
+            cfg.minY -= 1.0;
+            cfg.maxY += 1.0;
+        }
+        return cfg;
+    }
+
+    // Запись уровня пирамиды в текстовом виде. Первая строка:
+    // ширина, высота, координаты левого нижнего угла и размеры ячейки;
+    // далее строки сетки, начиная с минимального y
+    void writeLevel(std::ostream& os, const CoveragePyramid& pyramid, size_t level) const {
+        const CoverageGrid& grid = pyramid.getLevel(level);
+        double scale = std::ldexp(1.0, static_cast<int>(level));
+        double cellWidth = (config.maxX - config.minX) / config.width * scale;
+        double cellHeight = (config.maxY - config.minY) / config.height * scale;
+
+        os << grid.getWidth() << " " << grid.getHeight() << " "
+           << config.minX << " " << config.minY << " "
+           << cellWidth << " " << cellHeight << "\n";
+        for (size_t y = 0; y < grid.getHeight(); ++y) {
+            for (size_t x = 0; x < grid.getWidth(); ++x) {
+                os << grid.at(x, y);
+                if (x < grid.getWidth() - 1) os << " ";
+            }
+            os << "\n";
+        }
+    }
+};
+
+#endif
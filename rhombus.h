@@ -110,7 +110,7 @@ public:
     }
     
     // Геттеры
-    const std::vector<std::pair<double, double>>& getVertices() const { return vertices; }
+    const std::vector<std::pair<double, double>>& getVertices() const override { return vertices; }
 };
 
 #endif
\ No newline at end of file
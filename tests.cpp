@@ -0,0 +1,439 @@
+#include <gtest/gtest.h>
+#include "trapezoid.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include "array.h"
+#include "raster.h"
+#include "ingest.h"
+#include <cmath>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <unistd.h>
+#include <limits>
+
+namespace {
+
+FigureArray sampleFigures() {
+    FigureArray figures;
+    figures.addFigure(std::make_unique<Trapezoid>(
+        std::vector<std::pair<double, double>>{{0.3, 0.3}, {7.1, 0.3}, {5.2, 4.7}, {1.1, 4.7}}));
+    figures.addFigure(std::make_unique<Rhombus>(
+        std::vector<std::pair<double, double>>{{5, 6.5}, {8.5, 3}, {5, -0.5}, {1.5, 3}}));
+
+    std::vector<std::pair<double, double>> pentagon;
+    const double pi = std::acos(-1.0);
+    for (int i = 0; i < 5; ++i) {
+        pentagon.emplace_back(5 + 2.5 * std::cos(2 * pi * i / 5), 5 + 2.5 * std::sin(2 * pi * i / 5));
+    }
+    figures.addFigure(std::make_unique<Pentagon>(pentagon));
+    return figures;
+}
+
+RasterConfig sampleConfig() {
+    RasterConfig config;
+    config.minX = -1.0;
+    config.minY = -1.0;
+    config.maxX = 9.0;
+    config.maxY = 9.0;
+    config.width = 37;
+    config.height = 29;
+    config.tileSize = 5;
+    config.threads = 4;
+    return config;
+}
+
+// Временный каталог для входных файлов конвейера, удаляется вместе с тестом
+class TempDir {
+private:
+    std::filesystem::path root;
+
+public:
+    TempDir() {
+        static std::atomic<int> counter{0};
+        root = std::filesystem::temp_directory_path() /
+               ("lab3_ingest_" + std::to_string(::getpid()) + "_" + std::to_string(counter++));
+        std::filesystem::create_directories(root);
+    }
+
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+
+    std::string write(const std::string& name, const std::string& text) const {
+        std::string path = (root / name).string();
+        std::ofstream(path, std::ios::binary) << text;
+        return path;
+    }
+
+    std::string path(const std::string& name) const { return (root / name).string(); }
+};
+
+// Трапеция, сдвинутая по x: по ней можно проверить порядок фигур
+std::string trapezoidLine(double shift) {
+    std::ostringstream os;
+    os << "1 " << shift << " 0 " << shift + 4 << " 0 " << shift + 3 << " 2 " << shift + 1 << " 2\n";
+    return os.str();
+}
+
+std::unique_ptr<Figure> trapezoidAt(double shift) {
+    return std::make_unique<Trapezoid>(std::vector<std::pair<double, double>>{
+        {shift, 0}, {shift + 4, 0}, {shift + 3, 2}, {shift + 1, 2}});
+}
+
+// Файлы с lines трапециями каждый и ожидаемый результат загрузки
+std::vector<std::string> writeTrapezoidFiles(const TempDir& dir, size_t files, size_t lines,
+                                             FigureArray& expected) {
+    std::vector<std::string> paths;
+    for (size_t f = 0; f < files; ++f) {
+        std::string text;
+        for (size_t i = 0; i < lines; ++i) {
+            double shift = f * 1000.0 + i;
+            text += trapezoidLine(shift);
+            expected.addFigure(trapezoidAt(shift));
+        }
+        paths.push_back(dir.write("figures" + std::to_string(f) + ".txt", text));
+    }
+    return paths;
+}
+
+FigureArray square(double half) {
+    FigureArray figures;
+    figures.addFigure(std::make_unique<Rhombus>(
+        std::vector<std::pair<double, double>>{{-half, -half}, {half, -half}, {half, half}, {-half, half}}));
+    return figures;
+}
+
+}
+
+TEST(RasterTest, TotalCoverageEqualsArea) {
+    FigureArray figures = sampleFigures();
+    RasterConfig config = sampleConfig();
+    CoverageGrid grid = FigureRasterizer(config).rasterize(figures);
+
+    double cellArea = (config.maxX - config.minX) / config.width *
+                      (config.maxY - config.minY) / config.height;
+    EXPECT_NEAR(grid.total() * cellArea, figures.totalArea(), 1e-9);
+}
+
+TEST(RasterTest, TilesMatchSingleTile) {
+    FigureArray figures = sampleFigures();
+    RasterConfig tiled = sampleConfig();
+    RasterConfig whole = sampleConfig();
+    whole.tileSize = 1000;
+    whole.threads = 1;
+
+    CoverageGrid a = FigureRasterizer(tiled).rasterize(figures);
+    CoverageGrid b = FigureRasterizer(whole).rasterize(figures);
+    for (size_t y = 0; y < a.getHeight(); ++y) {
+        for (size_t x = 0; x < a.getWidth(); ++x) {
+            EXPECT_NEAR(a.at(x, y), b.at(x, y), 1e-12);
+        }
+    }
+}
+
+TEST(RasterTest, ShapeOnTileBoundaryIsSplit) {
+    // Ромб с центром на углу четырёх тайлов 4x4
+    FigureArray figures;
+    figures.addFigure(std::make_unique<Rhombus>(
+        std::vector<std::pair<double, double>>{{4, 6.5}, {6.5, 4}, {4, 1.5}, {1.5, 4}}));
+
+    RasterConfig config;
+    config.minX = 0.0;
+    config.minY = 0.0;
+    config.maxX = 8.0;
+    config.maxY = 8.0;
+    config.width = 8;
+    config.height = 8;
+    config.tileSize = 4;
+    CoverageGrid grid = FigureRasterizer(config).rasterize(figures);
+
+    EXPECT_NEAR(grid.total(), 12.5, 1e-12);
+    EXPECT_DOUBLE_EQ(grid.at(3, 3), 1.0);
+    EXPECT_DOUBLE_EQ(grid.at(4, 4), 1.0);
+    for (size_t y = 0; y < 4; ++y) {
+        for (size_t x = 0; x < 4; ++x) {
+            EXPECT_NEAR(grid.at(x, y), grid.at(7 - x, y), 1e-12);
+            EXPECT_NEAR(grid.at(x, y), grid.at(x, 7 - y), 1e-12);
+        }
+    }
+}
+
+TEST(RasterTest, PyramidPreservesScaledTotal) {
+    FigureArray figures = sampleFigures();
+    CoveragePyramid pyramid = FigureRasterizer(sampleConfig()).rasterizePyramid(figures);
+
+    ASSERT_EQ(pyramid.size(), 7u);
+    EXPECT_EQ(pyramid.getLevel(6).getWidth(), 1u);
+    EXPECT_EQ(pyramid.getLevel(6).getHeight(), 1u);
+    double base = pyramid.getLevel(0).total();
+    for (size_t level = 1; level < pyramid.size(); ++level) {
+        EXPECT_NEAR(pyramid.getLevel(level).total() * std::pow(4.0, level), base, 1e-9);
+    }
+}
+
+TEST(RasterTest, HugeFigureCoversViewportExactly) {
+    RasterConfig config;
+    config.width = 8;
+    config.height = 8;
+    config.tileSize = 4;
+    for (double half : {1e13, 1e15, 1e30}) {
+        CoverageGrid grid = FigureRasterizer(config).rasterize(square(half));
+        EXPECT_NEAR(grid.total(), 64.0, 1e-9);
+        for (size_t y = 0; y < 8; ++y) {
+            for (size_t x = 0; x < 8; ++x) {
+                EXPECT_NEAR(grid.at(x, y), 1.0, 1e-12);
+            }
+        }
+    }
+}
+
+TEST(RasterTest, InvalidConfigThrows) {
+    RasterConfig config;
+    config.width = 0;
+    EXPECT_THROW(FigureRasterizer(config).rasterize(square(1.0)), std::invalid_argument);
+}
+
+TEST(RasterTest, WriteLevelUsesFittedBounds) {
+    FigureArray figures = square(2.0);
+    RasterConfig config;
+    config.width = 4;
+    config.height = 4;
+    config.levels = 2;
+    FigureRasterizer rasterizer(FigureRasterizer::fitToFigures(figures, config));
+    CoveragePyramid pyramid = rasterizer.rasterizePyramid(figures);
+    ASSERT_EQ(pyramid.size(), 2u);
+
+    std::ostringstream os;
+    rasterizer.writeLevel(os, pyramid, 1);
+    EXPECT_EQ(os.str(), "2 2 -2 -2 2 2\n1 1\n1 1\n");
+}
+
+TEST(BoundedQueueTest, PopDrainsAfterClose) {
+    BoundedQueue<int> queue(4);
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_THROW(queue.push(3), std::logic_error);
+}
+
+TEST(BoundedQueueTest, PushBlocksWhenFull) {
+    BoundedQueue<int> queue(1);
+    queue.push(1);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&] {
+        queue.push(2);
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    producer.join();
+    EXPECT_TRUE(pushed);
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 2);
+}
+
+TEST(BoundedQueueTest, CloseWakesBlockedPush) {
+    BoundedQueue<int> queue(1);
+    queue.push(1);
+
+    std::atomic<bool> threw{false};
+    std::thread producer([&] {
+        try {
+            queue.push(2);
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+    });
+    queue.close();
+    producer.join();
+    EXPECT_TRUE(threw);
+}
+
+TEST(IngestTest, ManyFilesWithBlocksShorterThanLine) {
+    TempDir dir;
+    FigureArray expected;
+    std::vector<std::string> paths = writeTrapezoidFiles(dir, 4, 300, expected);
+
+    IngestConfig config;
+    config.blockSize = 7;
+    config.readers = 3;
+    config.parsers = 4;
+    config.validators = 3;
+    FigureArray figures;
+    IngestStats stats = FigureIngest(config).run(paths, figures);
+
+    EXPECT_EQ(figures.size(), 1200u);
+    EXPECT_EQ(stats.append.items, 1200u);
+    EXPECT_EQ(stats.rejected, 0u);
+    EXPECT_TRUE(stats.failedFiles.empty());
+    EXPECT_TRUE(figures == expected);
+
+    size_t bytes = 0;
+    for (const auto& path : paths) {
+        bytes += std::filesystem::file_size(path);
+    }
+    EXPECT_EQ(stats.bytesRead, bytes);
+    EXPECT_GT(stats.readBytesPerSecond(), 0.0);
+}
+
+TEST(IngestTest, OrderIsStableAcrossRuns) {
+    TempDir dir;
+    FigureArray expected;
+    std::vector<std::string> paths = writeTrapezoidFiles(dir, 3, 500, expected);
+
+    IngestConfig config;
+    config.blockSize = 64;
+    config.parsers = 4;
+    config.validators = 4;
+    for (int run = 0; run < 3; ++run) {
+        FigureArray figures;
+        FigureIngest(config).run(paths, figures);
+        EXPECT_TRUE(figures == expected);
+    }
+}
+
+TEST(IngestTest, SkipsCommentsAndCountsRejected) {
+    TempDir dir;
+    std::string text =
+        "# комментарий\n"
+        "\n"
+        "   \n" +
+        trapezoidLine(0) +
+        "2 0 1 1 0 0 -1 -1 0\n"
+        "2 0 0 5 0 0 7 1 1\n"                // ромб с разными сторонами
+        "3 1 0\n"                            // не хватает координат
+        "9 0 0 1 1 2 2 3 3\n"                // неизвестный тип
+        "1 0 0 4 0 3 2 1 2 лишнее\n"
+        "x 0 0\n" +
+        trapezoidLine(10);
+    std::string path = dir.write("mixed.txt", text);
+
+    FigureArray figures;
+    IngestStats stats = FigureIngest().run({path}, figures);
+
+    EXPECT_EQ(figures.size(), 3u);
+    EXPECT_EQ(stats.rejected, 5u);
+    EXPECT_EQ(stats.parse.items, 4u);
+    EXPECT_EQ(stats.validate.items, 3u);
+    EXPECT_TRUE(*figures.getFigure(0) == *trapezoidAt(0));
+    EXPECT_TRUE(*figures.getFigure(2) == *trapezoidAt(10));
+}
+
+TEST(IngestTest, UnreadableFilesAreListed) {
+    TempDir dir;
+    std::string good = dir.write("good.txt", trapezoidLine(0));
+    std::string missing = dir.path("missing.txt");
+    std::string directory = dir.path("subdir");
+    std::filesystem::create_directories(directory);
+
+    FigureArray figures;
+    IngestStats stats = FigureIngest().run({missing, good, directory}, figures);
+
+    EXPECT_EQ(figures.size(), 1u);
+    ASSERT_EQ(stats.failedFiles.size(), 2u);
+    EXPECT_EQ(stats.failedFiles[0], missing);
+    EXPECT_EQ(stats.failedFiles[1], directory);
+}
+
+TEST(IngestTest, BackpressureWithSingleSlotQueues) {
+    TempDir dir;
+    FigureArray expected;
+    std::vector<std::string> paths = writeTrapezoidFiles(dir, 5, 200, expected);
+
+    IngestConfig config;
+    config.queueCapacity = 1;
+    config.reorderBlocks = 1;
+    config.blockSize = 16;
+    config.readers = 4;
+    config.parsers = 3;
+    config.validators = 3;
+    FigureArray figures;
+    IngestStats stats = FigureIngest(config).run(paths, figures);
+
+    EXPECT_EQ(stats.append.items, 1000u);
+    EXPECT_TRUE(figures == expected);
+}
+
+TEST(IngestTest, AppendExceptionIsRethrownAfterJoin) {
+    TempDir dir;
+    FigureArray expected;
+    std::vector<std::string> paths = writeTrapezoidFiles(dir, 3, 400, expected);
+
+    IngestConfig config;
+    config.queueCapacity = 2;
+    config.blockSize = 32;
+    size_t calls = 0;
+    auto append = [&calls](std::unique_ptr<Figure>) {
+        if (++calls == 100) {
+            throw std::runtime_error("сбой добавления");
+        }
+    };
+
+    EXPECT_THROW(FigureIngest(config).run(paths, append), std::runtime_error);
+    EXPECT_EQ(calls, 100u);
+}
+
+TEST(RasterTest, OversizedGridIsRejected) {
+    RasterConfig config;
+    config.width = size_t(1) << 38;
+    config.height = size_t(1) << 38;
+    FigureArray figures = square(0.5);
+    FigureRasterizer rasterizer(FigureRasterizer::fitToFigures(figures, config));
+
+    EXPECT_THROW(rasterizer.rasterize(figures), std::invalid_argument);
+    EXPECT_THROW(CoverageGrid(size_t(1) << 38, size_t(1) << 38), std::invalid_argument);
+}
+
+TEST(RasterTest, HugeTileSizeMeansSingleTile) {
+    RasterConfig config;
+    config.width = 8;
+    config.height = 8;
+    config.tileSize = std::numeric_limits<size_t>::max();
+    CoverageGrid grid = FigureRasterizer(config).rasterize(square(10.0));
+    EXPECT_NEAR(grid.total(), 64.0, 1e-9);
+}
+
+TEST(RasterTest, NonConvexFigureIsRejected) {
+    // Самопересекающийся порядок вершин проходит проверку трапеции
+    FigureArray figures;
+    figures.addFigure(std::make_unique<Trapezoid>(
+        std::vector<std::pair<double, double>>{{0, 0}, {4, 0}, {1, 2}, {3, 2}}));
+
+    RasterConfig config = FigureRasterizer::fitToFigures(figures, RasterConfig());
+    EXPECT_THROW(FigureRasterizer(config).rasterize(figures), std::invalid_argument);
+
+    // Пентаграмма: равные стороны, все повороты в одну сторону, но два оборота
+    std::vector<std::pair<double, double>> star;
+    const double pi = std::acos(-1.0);
+    for (int i = 0; i < 5; ++i) {
+        star.emplace_back(std::cos(4 * pi * i / 5), std::sin(4 * pi * i / 5));
+    }
+    FigureArray stars;
+    stars.addFigure(std::make_unique<Pentagon>(star));
+    config = FigureRasterizer::fitToFigures(stars, RasterConfig());
+    EXPECT_THROW(FigureRasterizer(config).rasterize(stars), std::invalid_argument);
+}
+
+TEST(RasterTest, PyramidDepthMatchesBuiltLevels) {
+    EXPECT_EQ(CoveragePyramid::depthFor(1, 1), 1u);
+    EXPECT_EQ(CoveragePyramid::depthFor(37, 29), 7u);
+    EXPECT_EQ(CoveragePyramid::depthFor(size_t(1) << 40, 1), 41u);
+    EXPECT_EQ(CoveragePyramid::depthFor(std::numeric_limits<size_t>::max(), 1), 65u);
+}
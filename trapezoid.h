@@ -114,7 +114,7 @@ public:
         return true;
     }
     
-    const std::vector<std::pair<double, double>>& getVertices() const { return vertices; }
+    const std::vector<std::pair<double, double>>& getVertices() const override { return vertices; }
 };
 
 #endif
\ No newline at end of file